@@ -1,4 +1,5 @@
 #include "dead_code.h"
+#include "../helpers/utils.h"
 
 namespace sequre {
 
@@ -15,26 +16,129 @@ void countVarUsage( Value *instruction,
   
 }
 
-void eliminateDeadAssignments( SeriesFlow *series, std::set<codon::ir::id_t> &whitelist ) {
-  auto it = series->begin();
-  while ( it != series->end() ) {
+bool isSecureArithmetic( std::string const &operation ) {
+  return operation == Module::ADD_MAGIC_NAME ||
+         operation == Module::SUB_MAGIC_NAME ||
+         operation == Module::MUL_MAGIC_NAME ||
+         operation == Module::MATMUL_MAGIC_NAME ||
+         operation == Module::POW_MAGIC_NAME;
+}
+
+bool isPureSecureExpression( Value *value ) {
+  if ( util::getVar(value) ) return true;
+  if ( util::isConst<int64_t>(value) || util::isConst<double>(value) || util::isConst<bool>(value) ) return true;
+
+  auto *callInstr = cast<CallInstr>(value);
+  if ( !callInstr || !isBinaryInstr(callInstr) || !util::getFunc(callInstr->getCallee()) ) return false;
+  if ( !isSecureContainer(callInstr->getType()) || !isSecureArithmetic(getOperation(callInstr)) ) return false;
+
+  return isPureSecureExpression(callInstr->front()) && isPureSecureExpression(callInstr->back());
+}
+
+bool containsLoopExit( Value *value ) {
+  if ( cast<BreakInstr>(value) || cast<ContinueInstr>(value) ) return true;
+  // Breaks and continues of inner loops do not leave the enclosing body
+  if ( cast<ForFlow>(value) || cast<ImperativeForFlow>(value) || cast<WhileFlow>(value) ) return false;
+
+  for ( auto *usedValue : value->getUsedValues() )
+    if ( containsLoopExit(usedValue) ) return true;
+  return false;
+}
+
+bool eliminateNestedDeadAssignments( Value *value, std::set<codon::ir::id_t> const &whitelist ) {
+  // Nested series might be re-entered (loops): anything read in the function is live at their exit
+  if ( auto *series = cast<SeriesFlow>(value) ) return eliminateDeadAssignments(series, whitelist, whitelist, false);
+
+  auto changed = false;
+  for ( auto *usedValue : value->getUsedValues() ) changed |= eliminateNestedDeadAssignments(usedValue, whitelist);
+  return changed;
+}
+
+/*
+ * Backward liveness scan over a series. An assignment is dead if its variable is not live afterwards.
+ * Top-level assignments to variables that are never read are dropped regardless of their right-hand side;
+ * otherwise (dead stores and nested flows) only side-effect free secure arithmetic is dropped.
+ * In nested series, a break or continue leaves the body early: everything live at its exit is live there as well.
+ */
+bool eliminateDeadAssignments( SeriesFlow *series,
+                               std::set<codon::ir::id_t> live,
+                               std::set<codon::ir::id_t> const &whitelist,
+                               bool topLevel ) {
+  auto changed = false;
+  auto it      = series->end();
+  while ( it != series->begin() ) {
+    --it;
+
     auto *assIns = cast<AssignInstr>(*it);
     if ( !assIns ) {
-      ++it;
+      changed |= eliminateNestedDeadAssignments(*it, whitelist);
+      countVarUsage(*it, live);
+      if ( !topLevel && containsLoopExit(*it) ) live.insert(whitelist.begin(), whitelist.end());
       continue;
     }
 
     auto *lhsVar = assIns->getLhs();
-    if ( !whitelist.count(lhsVar->getId()) )
-      it = series->erase(it);
-    else ++it;
+    auto  id     = lhsVar->getId();
+    auto  dead   = !live.count(id) && !lhsVar->isGlobal() &&
+                   ( ( topLevel && !whitelist.count(id) ) || isPureSecureExpression(assIns->getRhs()) );
+
+    if ( dead ) {
+      it      = series->erase(it);
+      changed = true;
+      continue;
+    }
+
+    changed |= eliminateNestedDeadAssignments(assIns->getRhs(), whitelist);
+    live.erase(id);
+    countVarUsage(assIns, live);
   }
+
+  return changed;
 }
 
 void eliminateDeadCode( SeriesFlow *series ) {
-  std::set<codon::ir::id_t> whitelist;
-  for ( auto it = series->begin(); it != series->end(); ++it ) countVarUsage(*it, whitelist);
-  eliminateDeadAssignments(series, whitelist);
+  // Removing an assignment might kill the assignments of its operands as well
+  auto changed = true;
+  while ( changed ) {
+    std::set<codon::ir::id_t> whitelist;
+    for ( auto it = series->begin(); it != series->end(); ++it ) countVarUsage(*it, whitelist);
+    changed = eliminateDeadAssignments(series, {}, whitelist, true);
+  }
+}
+
+void releaseSecureTemporaries( BodiedFunc *bf ) {
+  auto *M      = bf->getModule();
+  auto *series = cast<SeriesFlow>(bf->getBody());
+
+  // Only function-local secure tensors are released: arguments and globals are owned elsewhere
+  std::map<codon::ir::id_t, Var *> temporaries;
+  for ( auto *var : *bf )
+    if ( !var->isGlobal() && ( isCiphertensor(var->getType()) || isSharetensor(var->getType()) ) )
+      temporaries[var->getId()] = var;
+
+  std::set<codon::ir::id_t> live;
+  auto it = series->end();
+  while ( it != series->begin() ) {
+    --it;
+
+    std::set<codon::ir::id_t> used;
+    countVarUsage(*it, used);
+
+    if ( !cast<ReturnInstr>(*it) ) {
+      for ( auto id : used ) {
+        if ( live.count(id) || !temporaries.count(id) ) continue;
+
+        // Rebinding the dead variable to an empty tensor drops its reference to the backing storage
+        auto *var     = temporaries[id];
+        auto *release = getOrRealizeSequreInternalMethod(M, "secure_release", {var->getType()}, {});
+        if ( !release || !util::getReturnType(release)->is(var->getType()) ) continue;
+        series->insert(std::next(it), M->Nr<AssignInstr>(var, util::call(release, {M->Nr<VarValue>(var)})));
+      }
+    }
+
+    if ( auto *assIns = cast<AssignInstr>(*it) ) live.erase(assIns->getLhs()->getId());
+    live.insert(used.begin(), used.end());
+  }
 }
 
 } // namespace sequre
@@ -7,7 +7,8 @@ namespace sequre {
 using namespace codon::ir;
 
 void countVarUsage( Value *, std::set<codon::ir::id_t> & );
-void eliminateDeadAssignments( SeriesFlow *, std::set<codon::ir::id_t> & );
+bool eliminateDeadAssignments( SeriesFlow *, std::set<codon::ir::id_t>, std::set<codon::ir::id_t> const &, bool );
 void eliminateDeadCode( SeriesFlow * );
+void releaseSecureTemporaries( BodiedFunc * );
 
 } // namespace sequre
@@ -0,0 +1,223 @@
+#include "level_planner.h"
+#include "../helpers/utils.h"
+
+namespace sequre {
+
+using namespace codon::ir;
+
+using SeriesIterator = std::list<Value *>::iterator;
+
+/*
+ * Level-planned region: a run of straight-line instructions (within a single series)
+ * whose ciphertensor arithmetic is refreshed once, upfront, by a single guard.
+ */
+struct LevelRegion {
+  bool                                   open     = false;
+  int                                    mulCount = 0;
+  SeriesIterator                         start;
+  std::map<codon::ir::id_t, int>         depths;
+  std::vector<Var *>                     inputs;
+  std::set<codon::ir::id_t>              inputIds;
+  std::vector<std::pair<Var *, Value *>> planned;
+};
+
+bool isPlannedOperation( std::string const &operation ) {
+  return operation == Module::ADD_MAGIC_NAME ||
+         operation == Module::SUB_MAGIC_NAME ||
+         operation == Module::MUL_MAGIC_NAME;
+}
+
+bool isScalarLeaf( Module *M, Value *value ) {
+  if ( util::isConst<int64_t>(value) || util::isConst<double>(value) ) return true;
+  if ( !util::getVar(value) ) return false;
+
+  auto *type = value->getType();
+  return type->is(M->getIntType()) || type->is(M->getFloatType());
+}
+
+bool isCiphertensorLeaf( Value *value ) {
+  return util::getVar(value) && isCiphertensor(value->getType());
+}
+
+bool referencesCiphertensor( Value *value ) {
+  for ( auto *var : value->getUsedVariables() )
+    if ( isCiphertensor(var->getType()) ) return true;
+
+  for ( auto *usedValue : value->getUsedValues() )
+    if ( referencesCiphertensor(usedValue) ) return true;
+
+  return false;
+}
+
+Func *getOrRealizeLeveledMul( Module *M, Value *mpcValue, CallInstr *callInstr ) {
+  auto *lhs = callInstr->front();
+  auto *rhs = callInstr->back();
+  return getOrRealizeSequreInternalMethod(
+    M, "secure_mul_leveled", {mpcValue->getType(), lhs->getType(), rhs->getType(), M->getIntType()}, {});
+}
+
+bool isPlannableExpression( Module *M, Value *mpcValue, Value *value ) {
+  if ( isCiphertensorLeaf(value) || isScalarLeaf(M, value) ) return true;
+
+  auto *callInstr = cast<CallInstr>(value);
+  if ( !callInstr || !isBinaryInstr(callInstr) || !util::getFunc(callInstr->getCallee()) ) return false;
+  if ( !isCiphertensor(callInstr->getType()) || !isCiphertensor(callInstr->front()->getType()) ) return false;
+
+  auto operation = getOperation(callInstr);
+  if ( !isPlannedOperation(operation) ) return false;
+
+  if ( operation == Module::MUL_MAGIC_NAME ) {
+    auto *method = getOrRealizeLeveledMul(M, mpcValue, callInstr);
+    if ( !method ) return false;
+    if ( !util::getReturnType(method)->is(callInstr->getType()) ) return false;
+  }
+
+  return isPlannableExpression(M, mpcValue, callInstr->front()) &&
+         isPlannableExpression(M, mpcValue, callInstr->back());
+}
+
+int expressionDepth( Value *value, LevelRegion &region ) {
+  if ( isCiphertensorLeaf(value) ) {
+    auto it = region.depths.find(util::getVar(value)->getId());
+    return it == region.depths.end() ? 0 : it->second;
+  }
+
+  auto *callInstr = cast<CallInstr>(value);
+  if ( !callInstr ) return 0;
+
+  auto depth = std::max(expressionDepth(callInstr->front(), region), expressionDepth(callInstr->back(), region));
+  return getOperation(callInstr) == Module::MUL_MAGIC_NAME ? depth + 1 : depth;
+}
+
+void registerInputs( Value *value, LevelRegion &region ) {
+  if ( isCiphertensorLeaf(value) ) {
+    auto *var = util::getVar(value);
+    if ( region.depths.count(var->getId()) || region.inputIds.count(var->getId()) ) return;
+    region.inputs.push_back(var);
+    region.inputIds.insert(var->getId());
+    return;
+  }
+
+  auto *callInstr = cast<CallInstr>(value);
+  if ( !callInstr ) return;
+
+  if ( getOperation(callInstr) == Module::MUL_MAGIC_NAME ) region.mulCount++;
+  registerInputs(callInstr->front(), region);
+  registerInputs(callInstr->back(), region);
+}
+
+void assignLeveledMuls( Module *M, Value *mpcValue, Value *value, int above, std::map<codon::ir::id_t, int> &needs ) {
+  // Needs: number of levels the planned region still consumes from each ciphertensor
+  if ( isCiphertensorLeaf(value) ) {
+    auto &need = needs[util::getVar(value)->getId()];
+    need = std::max(need, above);
+    return;
+  }
+
+  auto *callInstr = cast<CallInstr>(value);
+  if ( !callInstr ) return;
+
+  auto isMul = getOperation(callInstr) == Module::MUL_MAGIC_NAME;
+  auto *lhs  = callInstr->front();
+  auto *rhs  = callInstr->back();
+
+  assignLeveledMuls(M, mpcValue, lhs, above + isMul, needs);
+  assignLeveledMuls(M, mpcValue, rhs, above + isMul, needs);
+  if ( !isMul ) return;
+
+  auto *method = getOrRealizeLeveledMul(M, mpcValue, callInstr);
+  callInstr->setCallee(M->Nr<VarValue>(method));
+  callInstr->setArgs({M->Nr<VarValue>(util::getVar(mpcValue)), lhs, rhs, M->getInt(above)});
+}
+
+void closeRegion( Module *M, Value *mpcValue, SeriesFlow *series, LevelRegion &region ) {
+  if ( region.open && region.mulCount ) {
+    std::map<codon::ir::id_t, int> needs;
+    for ( auto it = region.planned.rbegin(); it != region.planned.rend(); ++it ) {
+      auto *lhs      = it->first;
+      auto rootNeed  = 0;
+      if ( lhs ) {
+        rootNeed = needs[lhs->getId()];
+        needs[lhs->getId()] = 0;
+      }
+      assignLeveledMuls(M, mpcValue, it->second, rootNeed, needs);
+    }
+
+    std::vector<Value *> tensors;
+    std::vector<Value *> distances;
+    for ( auto *var : region.inputs ) {
+      auto need = needs[var->getId()];
+      if ( !need ) continue;
+      tensors.push_back(M->Nr<VarValue>(var));
+      distances.push_back(M->getInt(need - 1));
+    }
+
+    if ( !tensors.empty() ) {
+      auto *tensorsTuple   = util::makeTuple(tensors, M);
+      auto *distancesTuple = util::makeTuple(distances, M);
+      auto *guardMethod    = getOrRealizeSequreInternalMethod(
+        M, "refresh_levels", {mpcValue->getType(), tensorsTuple->getType(), distancesTuple->getType()}, {});
+      assert( guardMethod && "Compile error: could not realize the level-planned region guard" );
+
+      auto *guard = util::call(guardMethod, {M->Nr<VarValue>(util::getVar(mpcValue)), tensorsTuple, distancesTuple});
+      series->insert(region.start, guard);
+    }
+  }
+
+  region = LevelRegion();
+}
+
+void planSeries( Module *M, Value *mpcValue, SeriesFlow *series );
+
+void planNestedSeries( Module *M, Value *mpcValue, Value *value ) {
+  if ( auto *series = cast<SeriesFlow>(value) ) {
+    planSeries(M, mpcValue, series);
+    return;
+  }
+
+  for ( auto *usedValue : value->getUsedValues() ) planNestedSeries(M, mpcValue, usedValue);
+}
+
+void planSeries( Module *M, Value *mpcValue, SeriesFlow *series ) {
+  LevelRegion region;
+
+  for ( auto it = series->begin(); it != series->end(); ++it ) {
+    Var   *lhs = nullptr;
+    Value *rhs = nullptr;
+
+    if ( auto *assIns = cast<AssignInstr>(*it) ) {
+      lhs = assIns->getLhs();
+      rhs = assIns->getRhs();
+    } else if ( auto *retIns = cast<ReturnInstr>(*it) ) {
+      rhs = retIns->getValue();
+    }
+
+    if ( rhs && isCiphertensor(rhs->getType()) && isPlannableExpression(M, mpcValue, rhs) ) {
+      if ( expressionDepth(rhs, region) > MHE_LEVEL_BUDGET ) closeRegion(M, mpcValue, series, region);
+
+      auto depth = expressionDepth(rhs, region);
+      if ( depth <= MHE_LEVEL_BUDGET ) {
+        if ( !region.open ) {
+          region.open  = true;
+          region.start = it;
+        }
+
+        registerInputs(rhs, region);
+        region.planned.push_back(std::make_pair(lhs, rhs));
+        if ( lhs ) region.depths[lhs->getId()] = depth;
+        continue;
+      }
+    }
+
+    if ( cast<Flow>(*it) || referencesCiphertensor(*it) ) closeRegion(M, mpcValue, series, region);
+    planNestedSeries(M, mpcValue, *it);
+  }
+
+  closeRegion(M, mpcValue, series, region);
+}
+
+void planBootstraps( BodiedFunc *bf, Value *mpcValue ) {
+  planSeries(bf->getModule(), mpcValue, cast<SeriesFlow>(bf->getBody()));
+}
+
+} // namespace sequre
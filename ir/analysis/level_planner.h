@@ -0,0 +1,16 @@
+#pragma once
+
+#include "codon/cir/util/irtools.h"
+
+namespace sequre {
+
+using namespace codon::ir;
+
+// Number of consecutive multiplications a ciphertext can undergo between two collective refreshes.
+// Derived from DEFAULT_PARAMS (PN14QP438) in stdlib/sequre/lattiseq/params.codon: the max level is 9
+// while the collective bootstrapping requires at least level 4 (128-bit security for up to 7 computing parties).
+const int MHE_LEVEL_BUDGET = 5;
+
+void planBootstraps( BodiedFunc *, Value * );
+
+} // namespace sequre
@@ -0,0 +1,159 @@
+#include "polynomial.h"
+#include "../helpers/utils.h"
+
+namespace sequre {
+
+using namespace codon::ir;
+
+/*
+ * Monomial of a univariate polynomial: (-)prod(factors) * x ** degree
+ * where factors are public scalars.
+ */
+struct PolynomialTerm {
+  int64_t              degree = 0;
+  bool                 negate = false;
+  std::vector<Value *> factors;
+};
+
+using PolynomialTerms = std::vector<PolynomialTerm>;
+
+bool isPolynomialCoefficient( Module *M, Value *value ) {
+  if ( util::isConst<int64_t>(value) || util::isConst<double>(value) ) return true;
+  if ( !util::getVar(value) ) return false;
+
+  auto *type = value->getType();
+  return type->is(M->getIntType()) || type->is(M->getFloatType());
+}
+
+bool multiplyPolynomials( PolynomialTerms const &lhs, PolynomialTerms const &rhs, PolynomialTerms &product ) {
+  if ( lhs.size() * rhs.size() > MAX_POLYNOMIAL_TERMS ) return false;
+
+  product.clear();
+  for ( auto &lhsTerm : lhs ) {
+    for ( auto &rhsTerm : rhs ) {
+      PolynomialTerm term;
+      term.degree  = lhsTerm.degree + rhsTerm.degree;
+      term.negate  = lhsTerm.negate ^ rhsTerm.negate;
+      term.factors = lhsTerm.factors;
+      term.factors.insert(term.factors.end(), rhsTerm.factors.begin(), rhsTerm.factors.end());
+      product.push_back(term);
+    }
+  }
+
+  return true;
+}
+
+bool parsePolynomial( Module *M, Value *value, Var *&variable, PolynomialTerms &terms ) {
+  terms.clear();
+
+  if ( isPolynomialCoefficient(M, value) ) {
+    terms.push_back({0, false, {value}});
+    return true;
+  }
+
+  if ( auto *var = util::getVar(value) ) {
+    if ( !isCiphertensor(var->getType()) || !hasCKKSCiphertext(var->getType()) ) return false;
+    if ( variable && variable->getId() != var->getId() ) return false;
+
+    variable = var;
+    terms.push_back({1, false, {}});
+    return true;
+  }
+
+  auto *callInstr = cast<CallInstr>(value);
+  if ( !callInstr || !util::getFunc(callInstr->getCallee()) ) return false;
+  auto operation = getOperation(callInstr);
+
+  if ( operation == Module::NEG_MAGIC_NAME && callInstr->numArgs() == 1 ) {
+    if ( !parsePolynomial(M, callInstr->front(), variable, terms) ) return false;
+    for ( auto &term : terms ) term.negate ^= true;
+    return true;
+  }
+
+  if ( !isBinaryInstr(callInstr) ) return false;
+
+  PolynomialTerms lhs, rhs;
+  if ( !parsePolynomial(M, callInstr->front(), variable, lhs) ) return false;
+
+  if ( operation == Module::POW_MAGIC_NAME ) {
+    auto *exponent = callInstr->back();
+    if ( !util::isConst<int64_t>(exponent) ) return false;
+
+    auto power = util::getConst<int64_t>(exponent);
+    if ( power < 1 || power > MAX_POLYNOMIAL_POW ) return false;
+
+    terms = lhs;
+    for ( int64_t i = 1; i < power; ++i ) {
+      PolynomialTerms product;
+      if ( !multiplyPolynomials(terms, lhs, product) ) return false;
+      terms = product;
+    }
+    return true;
+  }
+
+  if ( !parsePolynomial(M, callInstr->back(), variable, rhs) ) return false;
+
+  if ( operation == Module::MUL_MAGIC_NAME ) return multiplyPolynomials(lhs, rhs, terms);
+
+  if ( operation == Module::ADD_MAGIC_NAME || operation == Module::SUB_MAGIC_NAME ) {
+    if ( lhs.size() + rhs.size() > MAX_POLYNOMIAL_TERMS ) return false;
+
+    terms = lhs;
+    for ( auto term : rhs ) {
+      term.negate ^= ( operation == Module::SUB_MAGIC_NAME );
+      terms.push_back(term);
+    }
+    return true;
+  }
+
+  return false;
+}
+
+Value *cloneCoefficient( Module *M, Value *factor ) {
+  // Factors are shared among the expanded terms so each use gets its own node
+  if ( auto *var = util::getVar(factor) ) return M->Nr<VarValue>(var);
+  if ( util::isConst<int64_t>(factor) ) return M->getInt(util::getConst<int64_t>(factor));
+  return M->getFloat(util::getConst<double>(factor));
+}
+
+Value *generatePolynomialEvaluation( Module *M, Value *mpcValue, Var *variable, PolynomialTerms const &terms ) {
+  std::vector<Value *> termTuples;
+  for ( auto &term : terms ) {
+    std::vector<Value *> factors;
+    for ( auto *factor : term.factors ) factors.push_back(cloneCoefficient(M, factor));
+    termTuples.push_back(util::makeTuple({M->getInt(term.degree), M->getBool(term.negate), util::makeTuple(factors, M)}, M));
+  }
+
+  auto *termsTuple = util::makeTuple(termTuples, M);
+  auto *polyval    = getOrRealizeSequreInternalMethod(
+    M, "secure_polyval", {mpcValue->getType(), variable->getType(), termsTuple->getType()}, {});
+  if ( !polyval ) return nullptr;
+
+  return util::call(polyval, {M->Nr<VarValue>(util::getVar(mpcValue)), M->Nr<VarValue>(variable), termsTuple});
+}
+
+void lowerPolynomials( Module *M, Value *value, Value *mpcValue ) {
+  auto *callInstr = cast<CallInstr>(value);
+  if ( callInstr && isCiphertensor(callInstr->getType()) && hasCKKSCiphertext(callInstr->getType()) ) {
+    Var            *variable = nullptr;
+    PolynomialTerms terms;
+
+    if ( parsePolynomial(M, callInstr, variable, terms) && variable ) {
+      int64_t degree = 0;
+      for ( auto &term : terms ) degree = std::max(degree, term.degree);
+
+      if ( degree >= MIN_LOWERED_POLYNOMIAL_DEGREE ) {
+        auto *polynomial = generatePolynomialEvaluation(M, mpcValue, variable, terms);
+        if ( polynomial && polynomial->getType()->is(callInstr->getType()) ) {
+          polynomial->setSrcInfo(callInstr->getSrcInfo());
+          callInstr->replaceAll(polynomial);
+        }
+        return;
+      }
+    }
+  }
+
+  for ( auto *usedValue : value->getUsedValues() ) lowerPolynomials(M, usedValue, mpcValue);
+}
+
+} // namespace sequre
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "codon/cir/util/irtools.h"
+
+namespace sequre {
+
+using namespace codon::ir;
+
+const int64_t MIN_LOWERED_POLYNOMIAL_DEGREE = 3;
+const int64_t MAX_POLYNOMIAL_POW            = 64;
+const size_t  MAX_POLYNOMIAL_TERMS          = 256;
+
+void lowerPolynomials( Module *, Value *, Value * );
+
+} // namespace sequre
@@ -0,0 +1,94 @@
+#include "product_sum.h"
+#include "../helpers/utils.h"
+
+namespace sequre {
+
+using namespace codon::ir;
+
+bool isCipherCiphertensor( types::Type *type ) {
+  return isCiphertensor(type) && hasCKKSCiphertext(type);
+}
+
+bool isCipherArithmetic( CallInstr *callInstr, std::string const &operation ) {
+  if ( !callInstr || !isBinaryInstr(callInstr) || !util::getFunc(callInstr->getCallee()) ) return false;
+  if ( getOperation(callInstr) != operation ) return false;
+  return isCipherCiphertensor(callInstr->getType()) && isCipherCiphertensor(callInstr->front()->getType());
+}
+
+bool isCipherProduct( Value *value ) {
+  auto *callInstr = cast<CallInstr>(value);
+  return isCipherArithmetic(callInstr, Module::MUL_MAGIC_NAME) && isCipherCiphertensor(callInstr->back()->getType());
+}
+
+void collectSumTerms( Value *value, bool negate, std::vector<std::pair<Value *, bool>> &terms ) {
+  auto *callInstr = cast<CallInstr>(value);
+  auto isAdd = isCipherArithmetic(callInstr, Module::ADD_MAGIC_NAME);
+  auto isSub = isCipherArithmetic(callInstr, Module::SUB_MAGIC_NAME);
+
+  if ( !isAdd && !isSub ) {
+    terms.push_back(std::make_pair(value, negate));
+    return;
+  }
+
+  collectSumTerms(callInstr->front(), negate, terms);
+  collectSumTerms(callInstr->back(), negate ^ isSub, terms);
+}
+
+Value *generateProductSum( Module *M, Value *mpcValue, std::vector<std::pair<Value *, bool>> &terms ) {
+  std::vector<Value *> lhs, rhs, negate;
+  for ( auto &term : terms ) {
+    if ( !isCipherProduct(term.first) ) continue;
+    auto *callInstr = cast<CallInstr>(term.first);
+    lhs.push_back(callInstr->front());
+    rhs.push_back(callInstr->back());
+    negate.push_back(M->getBool(term.second));
+  }
+
+  auto *lhsTuple    = util::makeTuple(lhs, M);
+  auto *rhsTuple    = util::makeTuple(rhs, M);
+  auto *negateTuple = util::makeTuple(negate, M);
+  auto *mulSumFunc  = getOrRealizeSequreInternalMethod(
+    M, "secure_mul_sum", {mpcValue->getType(), lhsTuple->getType(), rhsTuple->getType(), negateTuple->getType()}, {});
+  if ( !mulSumFunc ) return nullptr;
+
+  Value *result = util::call(mulSumFunc, {M->Nr<VarValue>(util::getVar(mpcValue)), lhsTuple, rhsTuple, negateTuple});
+  for ( auto &term : terms ) {
+    if ( isCipherProduct(term.first) ) continue;
+
+    auto *resultType = result->getType();
+    auto *opFunc     = M->getOrRealizeMethod(
+      resultType, term.second ? Module::SUB_MAGIC_NAME : Module::ADD_MAGIC_NAME, {resultType, term.first->getType()});
+    if ( !opFunc ) return nullptr;
+
+    result = util::call(opFunc, {result, term.first});
+  }
+
+  return result;
+}
+
+void lowerProductSums( Module *M, Value *value, Value *mpcValue ) {
+  auto *callInstr = cast<CallInstr>(value);
+  if ( isCipherArithmetic(callInstr, Module::ADD_MAGIC_NAME) || isCipherArithmetic(callInstr, Module::SUB_MAGIC_NAME) ) {
+    std::vector<std::pair<Value *, bool>> terms;
+    collectSumTerms(callInstr, false, terms);
+
+    auto productsCount = 0;
+    for ( auto &term : terms ) productsCount += isCipherProduct(term.first);
+
+    // Factors and remaining terms might contain sums of products as well
+    for ( auto &term : terms ) lowerProductSums(M, term.first, mpcValue);
+
+    if ( productsCount > 1 ) {
+      auto *productSum = generateProductSum(M, mpcValue, terms);
+      if ( productSum && productSum->getType()->is(callInstr->getType()) ) {
+        productSum->setSrcInfo(callInstr->getSrcInfo());
+        callInstr->replaceAll(productSum);
+      }
+    }
+    return;
+  }
+
+  for ( auto *usedValue : value->getUsedValues() ) lowerProductSums(M, usedValue, mpcValue);
+}
+
+} // namespace sequre
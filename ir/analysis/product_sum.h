@@ -0,0 +1,11 @@
+#pragma once
+
+#include "codon/cir/util/irtools.h"
+
+namespace sequre {
+
+using namespace codon::ir;
+
+void lowerProductSums( Module *, Value *, Value * );
+
+} // namespace sequre
@@ -0,0 +1,211 @@
+#include "redundance.h"
+#include "../helpers/bet.h"
+#include "../helpers/utils.h"
+#include "codon/cir/util/cloning.h"
+
+namespace sequre {
+
+using namespace codon::ir;
+
+using SeriesIterator = std::list<Value *>::iterator;
+
+bool isRedundanceOperation( std::string const &operation ) {
+  return operation == Module::ADD_MAGIC_NAME ||
+         operation == Module::SUB_MAGIC_NAME ||
+         operation == Module::MUL_MAGIC_NAME ||
+         operation == Module::MATMUL_MAGIC_NAME ||
+         operation == Module::POW_MAGIC_NAME;
+}
+
+bool isRedundanceCandidate( CallInstr *callInstr ) {
+  if ( !isBinaryInstr(callInstr) || !util::getFunc(callInstr->getCallee()) ) return false;
+  if ( !isRedundanceOperation(getOperation(callInstr)) ) return false;
+  return isSecureContainer(callInstr->getType());
+}
+
+bool isRedundanceTree( BETNode *node ) {
+  if ( node->isLeaf() ) return node->checkIsVariable() || node->checkIsConst();
+  if ( !isRedundanceOperation(node->getOperation()) ) return false;
+  return isRedundanceTree(node->getLeftChild()) && isRedundanceTree(node->getRightChild());
+}
+
+void collectTreeVars( BETNode *node, std::set<codon::ir::id_t> &vars ) {
+  if ( node->isLeaf() ) {
+    if ( node->checkIsVariable() ) vars.insert(node->getVariableId());
+    return;
+  }
+
+  collectTreeVars(node->getLeftChild(), vars);
+  collectTreeVars(node->getRightChild(), vars);
+}
+
+/*
+ * Expression class: the first occurrence of a secure subtree,
+ * the variables it reads and the variable that carries its value.
+ */
+struct RedundanceClass {
+  BETNode                   *node;
+  std::set<codon::ir::id_t>  deps;
+  codon::ir::id_t            holderId;
+  Var                       *holder;
+  int                        occurrences;
+  bool                       available;
+};
+
+class RedundanceEliminator {
+  Module     *M;
+  SeriesFlow *series;
+  BodiedFunc *func;
+  bool        rewrite;
+
+  std::set<codon::ir::id_t>    escaping;
+  std::vector<RedundanceClass> classes;
+  std::vector<int>             occurrences;
+
+public:
+  RedundanceEliminator( SeriesFlow *series, BodiedFunc *func )
+    : M(series->getModule()), series(series), func(func), rewrite(false) {}
+  ~RedundanceEliminator() { clearClasses(); }
+
+  void run();
+
+private:
+  void collectEscaping( Value *, bool );
+  void clearClasses();
+  void invalidate( codon::ir::id_t, int );
+  bool isEscaping( std::set<codon::ir::id_t> const & ) const;
+  int  findClass( BETNode * ) const;
+  int  registerClass( BETNode *, CallInstr *, SeriesIterator, Var * );
+  int  visitValue( Value *, SeriesIterator, Var * );
+  void visitInstruction( SeriesIterator );
+};
+
+void RedundanceEliminator::run() {
+  for ( auto it = series->begin(); it != series->end(); ++it ) collectEscaping(*it, false);
+
+  // Counting pass: find how many times each expression class is computed
+  for ( auto it = series->begin(); it != series->end(); ++it ) visitInstruction(it);
+  for ( auto &cls : classes ) occurrences.push_back(cls.occurrences);
+  clearClasses();
+
+  // Rewriting pass: compute each repeated class once and reuse it downstream
+  rewrite = true;
+  for ( auto it = series->begin(); it != series->end(); ++it ) visitInstruction(it);
+}
+
+void RedundanceEliminator::collectEscaping( Value *value, bool nested ) {
+  // Variables that are mutated out of sight (within nested flows or by non-arithmetic calls)
+  // cannot safely carry or feed a shared value.
+  auto *assIns = cast<AssignInstr>(value);
+  if ( assIns && nested ) escaping.insert(assIns->getLhs()->getId());
+
+  auto *callInstr = cast<CallInstr>(value);
+  if ( callInstr ) {
+    auto *f = util::getFunc(callInstr->getCallee());
+    if ( !f || !isRedundanceOperation(f->getUnmangledName()) )
+      for ( auto *arg : *callInstr )
+        if ( auto *var = util::getVar(arg) ) escaping.insert(var->getId());
+  }
+
+  auto isFlow = bool(cast<Flow>(value));
+  for ( auto *usedValue : value->getUsedValues() ) collectEscaping(usedValue, nested || isFlow);
+}
+
+void RedundanceEliminator::clearClasses() {
+  for ( auto &cls : classes ) delete cls.node;
+  classes.clear();
+}
+
+void RedundanceEliminator::invalidate( codon::ir::id_t varId, int keepIdx ) {
+  for ( int i = 0; i < classes.size(); ++i ) {
+    auto &cls = classes[i];
+    if ( cls.deps.count(varId) ) cls.available = false;
+    else if ( cls.holderId == varId && i != keepIdx ) cls.available = false;
+  }
+}
+
+bool RedundanceEliminator::isEscaping( std::set<codon::ir::id_t> const &vars ) const {
+  for ( auto varId : vars )
+    if ( escaping.count(varId) ) return true;
+  return false;
+}
+
+int RedundanceEliminator::findClass( BETNode *node ) const {
+  for ( int i = 0; i < classes.size(); ++i )
+    if ( classes[i].available && node->checkIsSameTree(classes[i].node) ) return i;
+  return -1;
+}
+
+int RedundanceEliminator::registerClass( BETNode *node, CallInstr *callInstr, SeriesIterator it, Var *lhs ) {
+  RedundanceClass cls;
+  cls.node        = node;
+  cls.holderId    = lhs ? lhs->getId() : BET::BET_NO_VAR_ID;
+  cls.holder      = lhs;
+  cls.occurrences = 1;
+  cls.available   = !lhs || !escaping.count(lhs->getId());
+  collectTreeVars(node, cls.deps);
+
+  int idx = classes.size();
+  if ( rewrite && !cls.holder && occurrences[idx] > 1 ) {
+    util::CloneVisitor cv(M);
+    auto *var = M->Nr<Var>(callInstr->getType(), false, false, "redundance_" + std::to_string(idx));
+    func->push_back(var);
+    series->insert(it, M->Nr<AssignInstr>(var, cv.clone(callInstr)));
+    callInstr->replaceAll(M->Nr<VarValue>(var));
+    cls.holder = var;
+  }
+
+  classes.push_back(cls);
+  return idx;
+}
+
+int RedundanceEliminator::visitValue( Value *value, SeriesIterator it, Var *lhs ) {
+  auto *callInstr = cast<CallInstr>(value);
+  if ( !callInstr ) return -1;
+
+  auto *node = isRedundanceCandidate(callInstr) ? parseBinaryArithmetic(callInstr) : nullptr;
+  if ( node && isRedundanceTree(node) ) {
+    std::set<codon::ir::id_t> deps;
+    collectTreeVars(node, deps);
+
+    if ( !isEscaping(deps) ) {
+      auto idx = findClass(node);
+      if ( idx != -1 && !(lhs && escaping.count(lhs->getId())) ) {
+        delete node;
+        if ( rewrite ) callInstr->replaceAll(M->Nr<VarValue>(classes[idx].holder));
+        else classes[idx].occurrences++;
+        return -1;
+      }
+
+      for ( auto *arg : *callInstr ) visitValue(arg, it, nullptr);
+      return registerClass(node, callInstr, it, lhs);
+    }
+  }
+
+  if ( node ) delete node;
+  for ( auto *arg : *callInstr ) visitValue(arg, it, nullptr);
+  return -1;
+}
+
+void RedundanceEliminator::visitInstruction( SeriesIterator it ) {
+  auto *assIns = cast<AssignInstr>(*it);
+  if ( assIns ) {
+    auto *lhs = assIns->getLhs();
+    invalidate(lhs->getId(), visitValue(assIns->getRhs(), it, lhs));
+    return;
+  }
+
+  auto *retIns = cast<ReturnInstr>(*it);
+  if ( retIns ) {
+    if ( retIns->getValue() ) visitValue(retIns->getValue(), it, nullptr);
+    return;
+  }
+
+  visitValue(*it, it, nullptr);
+}
+
+void eliminateRedundance( SeriesFlow *series, BodiedFunc *func ) {
+  RedundanceEliminator(series, func).run();
+}
+
+} // namespace sequre
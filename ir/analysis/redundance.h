@@ -0,0 +1,12 @@
+#pragma once
+
+#include "codon/cir/util/irtools.h"
+
+namespace sequre {
+
+using namespace codon::ir;
+
+bool isRedundanceCandidate( CallInstr * );
+void eliminateRedundance( SeriesFlow *, BodiedFunc * );
+
+} // namespace sequre
@@ -0,0 +1,143 @@
+#include "batching.h"
+#include "helpers/utils.h"
+#include "codon/cir/util/irtools.h"
+
+namespace sequre {
+
+using namespace codon::ir;
+
+using SeriesIterator = std::list<Value *>::iterator;
+
+/*
+ * Group of data-independent Sharetensor (mat)multiplications within a series
+ * that are lowered to a single batched Beaver round.
+ */
+struct ProductBatch {
+  std::string                 operation;
+  types::Type                *type = nullptr;
+  std::vector<SeriesIterator> members;
+  std::set<codon::ir::id_t>   defs;
+};
+
+CallInstr *getBatchableProduct( Value *instruction ) {
+  auto *assIns = cast<AssignInstr>(instruction);
+  if ( !assIns ) return nullptr;
+
+  auto *callInstr = cast<CallInstr>(assIns->getRhs());
+  if ( !callInstr || !isBinaryInstr(callInstr) || !util::getFunc(callInstr->getCallee()) ) return nullptr;
+
+  auto operation = getOperation(callInstr);
+  if ( operation != Module::MUL_MAGIC_NAME && operation != Module::MATMUL_MAGIC_NAME ) return nullptr;
+
+  auto *type = callInstr->getType();
+  if ( !isSharetensor(type) ) return nullptr;
+
+  for ( auto *arg : *callInstr )
+    if ( !util::getVar(arg) || !arg->getType()->is(type) ) return nullptr;
+
+  return callInstr;
+}
+
+bool referencesSharetensor( Value *value ) {
+  for ( auto *var : value->getUsedVariables() )
+    if ( isSharetensor(var->getType()) ) return true;
+
+  for ( auto *usedValue : value->getUsedValues() )
+    if ( referencesSharetensor(usedValue) ) return true;
+
+  return false;
+}
+
+void flushBatch( Module *M, Var *mpcVar, BodiedFunc *bf, SeriesFlow *series, ProductBatch &batch ) {
+  if ( batch.members.size() > 1 ) {
+    std::vector<Value *> lhs, rhs;
+    for ( auto it : batch.members ) {
+      auto *callInstr = getBatchableProduct(*it);
+      lhs.push_back(M->Nr<VarValue>(util::getVar(callInstr->front())));
+      rhs.push_back(M->Nr<VarValue>(util::getVar(callInstr->back())));
+    }
+
+    auto *mpcValue = M->Nr<VarValue>(mpcVar);
+    auto *lhsTuple = util::makeTuple(lhs, M);
+    auto *rhsTuple = util::makeTuple(rhs, M);
+    auto *method   = getOrRealizeSequreInternalMethod(
+      M, batch.operation == Module::MUL_MAGIC_NAME ? "secure_mul_bulk" : "secure_matmul_bulk",
+      {mpcValue->getType(), lhsTuple->getType(), rhsTuple->getType()}, {});
+
+    auto *bulkType = method ? util::getReturnType(method) : nullptr;
+    auto *getItem  = bulkType ? M->getOrRealizeMethod(bulkType, Module::GETITEM_MAGIC_NAME, {bulkType, M->getIntType()}) : nullptr;
+
+    if ( getItem && util::getReturnType(getItem)->is(batch.type) ) {
+      auto *bulkVar = M->Nr<Var>(bulkType, false, false, "batched_products");
+      bf->push_back(bulkVar);
+      auto *bulkCall = util::call(method, {mpcValue, lhsTuple, rhsTuple});
+      bulkCall->setSrcInfo((*batch.members.front())->getSrcInfo());
+      series->insert(batch.members.front(), M->Nr<AssignInstr>(bulkVar, bulkCall));
+
+      for ( int i = 0; i < batch.members.size(); ++i )
+        cast<AssignInstr>(*batch.members[i])->setRhs(util::call(getItem, {M->Nr<VarValue>(bulkVar), M->getInt(i)}));
+    }
+  }
+
+  batch = ProductBatch();
+}
+
+void batchSeries( Module *M, Var *mpcVar, BodiedFunc *bf, SeriesFlow *series );
+
+void batchNestedSeries( Module *M, Var *mpcVar, BodiedFunc *bf, Value *value ) {
+  if ( auto *series = cast<SeriesFlow>(value) ) {
+    batchSeries(M, mpcVar, bf, series);
+    return;
+  }
+
+  for ( auto *usedValue : value->getUsedValues() ) batchNestedSeries(M, mpcVar, bf, usedValue);
+}
+
+void batchSeries( Module *M, Var *mpcVar, BodiedFunc *bf, SeriesFlow *series ) {
+  ProductBatch batch;
+
+  for ( auto it = series->begin(); it != series->end(); ++it ) {
+    auto *product = getBatchableProduct(*it);
+    if ( product ) {
+      auto operation = getOperation(product);
+      auto joinable  = !batch.members.empty() &&
+                       operation == batch.operation &&
+                       product->getType()->is(batch.type) &&
+                       !batch.defs.count(util::getVar(product->front())->getId()) &&
+                       !batch.defs.count(util::getVar(product->back())->getId());
+
+      if ( !joinable ) {
+        flushBatch(M, mpcVar, bf, series, batch);
+        batch.operation = operation;
+        batch.type      = product->getType();
+      }
+
+      batch.members.push_back(it);
+      batch.defs.insert(cast<AssignInstr>(*it)->getLhs()->getId());
+      continue;
+    }
+
+    // Instructions that do not touch secure shares can be jumped over by the batch
+    if ( cast<Flow>(*it) || referencesSharetensor(*it) ) flushBatch(M, mpcVar, bf, series, batch);
+    batchNestedSeries(M, mpcVar, bf, *it);
+  }
+
+  flushBatch(M, mpcVar, bf, series, batch);
+}
+
+void RoundBatching::handle( CallInstr *v ) {
+  auto *f = util::getFunc(v->getCallee());
+  if ( !f || !hasSequreAttr(f) ) return;
+  if ( batchedFuncs.count(f->getId()) ) return;
+  batchedFuncs.insert(f->getId());
+
+  auto *bf = cast<BodiedFunc>(f);
+  if ( !bf || f->arg_begin() == f->arg_end() ) return;
+
+  auto *mpcVar = f->arg_front();
+  assert( isMPC(v->getModule()->Nr<VarValue>(mpcVar)) && "ERROR: The first argument of sequre function should be the MPC instance" );
+
+  batchSeries(v->getModule(), mpcVar, bf, cast<SeriesFlow>(bf->getBody()));
+}
+
+} // namespace sequre
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "codon/cir/transform/pass.h"
+#include "codon/cir/cir.h"
+
+namespace sequre {
+
+class RoundBatching : public codon::ir::transform::OperatorPass {
+  const std::string KEY = "sequre-round-batching";
+  std::string getKey() const override { return KEY; }
+
+  std::set<codon::ir::id_t> batchedFuncs;
+
+  void handle( codon::ir::CallInstr * ) override;
+};
+
+} // namespace sequre
@@ -9,36 +9,17 @@ namespace sequre {
 
 using namespace codon::ir;
 
-class SecureVarsSingleton {
-public:
-  static SecureVarsSingleton& instance() {
-    static SecureVarsSingleton inst;
-    return inst;
-  }
-  Var *get( Var *secureVar ) {
-    auto *M  = secureVar->getModule();
-    auto  it = map.find(secureVar->getId());
-    
-    if ( it != map.end() )
-      return M->getVar(it->second);
-    
-    return nullptr;
-  }
-  void insert( codon::ir::id_t varId, Var *var ) {
-    map.insert({varId, var->getId()});
-  }
-private:
-  SecureVarsSingleton() = default;
-  ~SecureVarsSingleton() = default;
-  std::unordered_map<codon::ir::id_t, codon::ir::id_t> map;
-};
+Var *Debugger::getRawVar( Var *secureVar ) {
+  auto it = rawVars.find(secureVar->getId());
+  return it == rawVars.end() ? nullptr : secureVar->getModule()->getVar(it->second);
+}
 
 void Debugger::replaceVars( Value *v, VarValue *mpc ) {
   auto *var = util::getVar(v);
   
   if ( var ) {
     if ( isSecureContainer(var->getType()) ) {
-      auto *rawVar = SecureVarsSingleton::instance().get(var);
+      auto *rawVar = getRawVar(var);
 
       if ( !rawVar ) {
         auto *M         = v->getModule();
@@ -47,7 +28,7 @@ void Debugger::replaceVars( Value *v, VarValue *mpc ) {
         auto *rawAssign = M->Nr<AssignInstr>(rawVar, reveal);
 
         insertBefore(rawAssign);
-        SecureVarsSingleton::instance().insert(var->getId(), rawVar);
+        rawVars[var->getId()] = rawVar;
       }
       
       v->replaceUsedVariable(var, rawVar);
@@ -80,26 +61,30 @@ void Debugger::attachDebugger( AssignInstr *v ) {
   auto *rawRhs = cv.clone(rhs);
   replaceVars(rawRhs, mpc);
 
-  auto *revealLhs = revealCall(lhs, mpc);
-  auto *rawLhs    = M->Nr<Var>(revealLhs->getType(), false, false, "raw_" + lhs->getName());
+  // Each secure var keeps a single raw mirror which is reassigned along with it
+  auto *rawLhs = getRawVar(lhs);
+  if ( !rawLhs || !rawLhs->getType()->is(rawRhs->getType()) ) {
+    rawLhs = M->Nr<Var>(rawRhs->getType(), false, false, "raw_" + lhs->getName());
+    rawVars[lhs->getId()] = rawLhs;
+  }
   auto *rawAssign = M->Nr<AssignInstr>(rawLhs, rawRhs);
-  SecureVarsSingleton::instance().insert(lhs->getId(), rawLhs);
 
   auto it = body->begin();
   while ( *it != v && it != body->end() ) ++it;
   body->insert(it++, rawAssign);
 
+  // Revealing (and sampling) of the secure value is left to the runtime: see DEBUG_SAMPLE_* settings
   auto *assertFunc = M->getOrRealizeFunc(
-    "assert_eq_approx",
-    {M->getStringType(), rawLhs->getType(), rawLhs->getType(), M->getFloatType(), M->getBoolType()}, {},
+    "assert_sampled_eq_approx",
+    {mpc->getType(), M->getStringType(), lhs->getType(), rawLhs->getType(), M->getFloatType()}, {},
     "std.sequre.utils.testing");
-  assert ( assertFunc && "SEQURE TYPE REALIZATION ERROR: Could not realize std.sequre.utils.testing.assert_eq_approx" );
+  assert ( assertFunc && "SEQURE TYPE REALIZATION ERROR: Could not realize std.sequre.utils.testing.assert_sampled_eq_approx" );
   
   auto srcInfo     = v->getSrcInfo();
   auto srcPath     = srcInfo.file + ":" + std::to_string(srcInfo.line);
   auto *assertCall = util::call(
     assertFunc,
-    {M->getString(srcPath), M->Nr<VarValue>(rawLhs), revealLhs, M->getFloat(0.02), M->getBool(false)});
+    {M->Nr<VarValue>(pf->arg_front()), M->getString(srcPath), M->Nr<VarValue>(lhs), M->Nr<VarValue>(rawLhs), M->getFloat(0.02)});
   body->insert(it++, assertCall);
 }
 
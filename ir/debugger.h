@@ -9,10 +9,14 @@ class Debugger : public codon::ir::transform::OperatorPass {
   const std::string KEY = "sequre-debugger";
   std::string getKey() const override { return KEY; }
 
+  // Secure var id -> id of its single raw (revealed) mirror
+  std::unordered_map<codon::ir::id_t, codon::ir::id_t> rawVars;
+
   void handle( codon::ir::AssignInstr * ) override;
   
   void attachDebugger( codon::ir::AssignInstr * );
   void replaceVars( codon::ir::Value *, codon::ir::VarValue * );
+  codon::ir::Var *getRawVar( codon::ir::Var * );
 };
 
 } // namespace sequre
@@ -125,6 +125,7 @@ void ExpressivenessTransformations::enableSecurity( CallInstr *v ) {
       betMatmulHelper,
       {mpc, firstArg, secondArg, tree, firstArgId, secondArgId});
     assert(betMatmulCall);
+    betMatmulCall->setSrcInfo(v->getSrcInfo());
 
     v->replaceAll(betMatmulCall);
     return;
@@ -138,6 +139,7 @@ void ExpressivenessTransformations::enableSecurity( CallInstr *v ) {
   }
 
   auto *func = util::call(method, args);
+  func->setSrcInfo(v->getSrcInfo());
   v->replaceAll(func);
 }
 
@@ -12,6 +12,7 @@ const std::string cipherTensorTypeName = "std.sequre.types.ciphertensor.Cipherte
 const std::string MPPTypeName = "std.sequre.types.multiparty_partition.MPP";
 const std::string MPATypeName = "std.sequre.types.multiparty_aggregate.MPA";
 const std::string MPUTypeName = "std.sequre.types.multiparty_union.MPU";
+const std::string MPCEnvTypeName = "std.sequre.mpc.env.MPCEnv";
 
 
 std::pair<std::vector<Value *>, std::vector<types::Type *>> getTypedArgs( CallInstr *v, int skip) {
@@ -107,6 +108,10 @@ bool isSecureContainer( types::Type *t ) {
   return isSharetensor(t) || isCiphertensor(t) || isMP(t);
 }
 
+bool isMPCEnv( types::Type *t ) {
+  return t->getName().rfind(MPCEnvTypeName, 0) == 0;
+}
+
 bool isMPC( Value *value ) {
   auto generics = value->getType()->getGenerics();
   assert( generics.size() == 1 && "ERROR: While testing if value is the MPC instance. It should have one and only one generic type." );
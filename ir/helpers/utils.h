@@ -30,6 +30,7 @@ bool isMPA( types::Type * );
 bool isMPU( types::Type * );
 bool isMP( types::Type * );
 bool isSecureContainer( types::Type * );
+bool isMPCEnv( types::Type * );
 bool isMPC( Value * );
 
 types::Type *getTupleType( int, types::Type *, Module * );
@@ -3,6 +3,10 @@
 #include "helpers/utils.h"
 #include "analysis/consecutive_matmul.h"
 #include "analysis/dead_code.h"
+#include "analysis/level_planner.h"
+#include "analysis/polynomial.h"
+#include "analysis/product_sum.h"
+#include "analysis/redundance.h"
 #include "codon/cir/util/cloning.h"
 #include "codon/cir/util/operator.h"
 #include "codon/cir/util/irtools.h"
@@ -56,24 +60,32 @@ std::pair<Value *, BETNode *> minimizeCipherMult( Module *M, Value *instruction,
   return std::make_pair(instruction, new BETNode(instruction));
 }
 
-void transformExpressions( Module *M, SeriesFlow *series, Value *mpcValue ) {
-  auto *bet = new BET();
+void transformExpressions( Module *M, BodiedFunc *bf, Value *mpcValue ) {
+  auto *series = cast<SeriesFlow>(bf->getBody());
+  auto *bet    = new BET();
   for ( auto it = series->begin(); it != series->end(); ++it ) minimizeCipherMult(M, *it, bet);
   eliminateDeadCode(series);
-  // eliminateRedundance(M, series, bet);
+  lowerPolynomials(M, series, mpcValue);
+  eliminateRedundance(series, bf);
+  lowerProductSums(M, series, mpcValue);
   reorderConsecutiveMatmuls(series, mpcValue);
+  planBootstraps(bf, mpcValue);
+  releaseSecureTemporaries(bf);
 }
 
-void applyCipherPlainOptimizations( CallInstr *v ) {
+void applyCipherPlainOptimizations( CallInstr *v, std::set<codon::ir::id_t> &optimizedFuncs ) {
   auto *M = v->getModule();
   auto *f = util::getFunc(v->getCallee());
   if ( !hasCipherOptAttr(f) ) return;
+  // The body is shared by all call sites: transform it only once
+  if ( optimizedFuncs.count(f->getId()) ) return;
+  optimizedFuncs.insert(f->getId());
   assert( v->numArgs() > 0 && "Compile error: The first argument of the mhe_cipher_opt annotated function should be the MPC instance (annotated function has no args)" );
 
   auto *mpcValue = M->Nr<VarValue>(f->arg_front());
   assert( isMPC(mpcValue) && "Compile error: The first argument of the mhe_cipher_opt annotated function should be the MPC instance" );
   
-  transformExpressions(M, cast<SeriesFlow>(cast<BodiedFunc>(f)->getBody()), mpcValue);
+  transformExpressions(M, cast<BodiedFunc>(f), mpcValue);
 }
 
 /* Encoding optimization */
@@ -131,7 +143,7 @@ void applyEncodingOptimization( CallInstr *v ) {
 /* Handle */
 
 void MHEOptimizations::handle( CallInstr *v ) {
-  applyCipherPlainOptimizations(v);
+  applyCipherPlainOptimizations(v, optimizedFuncs);
   applyEncodingOptimization(v);
 }
 
@@ -9,6 +9,8 @@ class MHEOptimizations : public codon::ir::transform::OperatorPass {
   const std::string KEY = "sequre-mhe-opt";
   std::string getKey() const override { return KEY; }
 
+  std::set<codon::ir::id_t> optimizedFuncs;
+
   void handle( codon::ir::CallInstr * ) override;
 };
 
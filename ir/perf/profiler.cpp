@@ -1,41 +1,55 @@
 #include "profiler.h"
-// #include "codon/sir/util/cloning.h"
+#include "../helpers/utils.h"
 #include "codon/cir/util/irtools.h"
-// #include "codon/sir/util/matching.h"
-// #include <iterator>
-// #include <math.h>
 
 namespace sequre {
 
 using namespace codon::ir;
 
-const std::string perfModule = "std.perf";
-const std::string perfProfileMethod = "__internal__perf_profile";
+const std::string perfModule          = "std.perf";
+const std::string secureProfileMethod = "__internal__secure_profile";
 
-void Profiler::attachProfiler(CallInstr *v) {
-  Func *f = util::getFunc(v->getCallee());
-  if (!f)
-    return;
+const std::string secureReleaseMethod = "secure_release";
 
-  Module *M = v->getModule();
-  Value *funcVal = M->Nr<VarValue>(f->getActual());
-  types::Type *funcType = cast<types::FuncType>(f->getType());
-  std::vector<Value *> args = {M->getString(f->getName()), funcVal};
-  std::vector<types::Type *> argsTypes = {M->getStringType(), funcType};
+bool isLoweredSecureCall( Func *f ) {
+  // Secure expressions are lowered to the secure_* methods of Internal. Releases of dead temporaries are bookkeeping only.
+  auto *parentType = f->getParentType();
+  if ( !parentType ) return false;
 
-  for (auto it = v->begin(); it != v->end(); ++it) {
-    args.push_back(*it);
-    argsTypes.push_back((*it)->getType());
+  auto *M                  = f->getModule();
+  auto *sequreInternalType = M->getOrRealizeType("Internal", {}, "std.sequre.types.internal");
+  if ( !sequreInternalType || !parentType->is(sequreInternalType) ) return false;
+
+  auto name = f->getUnmangledName();
+  return name.rfind("secure_", 0) == 0 && name != secureReleaseMethod;
+}
+
+void Profiler::attachProfiler( CallInstr *v ) {
+  auto *f  = util::getFunc(v->getCallee());
+  auto *pf = getParentFunc();
+  if ( !f || !pf || !hasSequreAttr(pf) || !isLoweredSecureCall(f) ) return;
+  if ( v->begin() == v->end() || !isMPCEnv(v->front()->getType()) ) return;
+
+  // Calls are attributed to the source line of the secure expression they were lowered from
+  auto *M        = v->getModule();
+  auto  srcInfo  = v->getSrcInfo();
+  auto  location = srcInfo.file + ":" + std::to_string(srcInfo.line);
+
+  std::vector<Value *>       args      = {M->getString(location), M->getString(f->getUnmangledName()), M->Nr<VarValue>(f->getActual())};
+  std::vector<types::Type *> argsTypes = {M->getStringType(), M->getStringType(), f->getType()};
+  for ( auto *arg : *v ) {
+    args.push_back(arg);
+    argsTypes.push_back(arg->getType());
   }
-  
-  auto *method = M->getOrRealizeFunc(perfProfileMethod, argsTypes, {}, perfModule);
-  if (!method)
-    return;
 
-  auto *func = util::call(method, args);
-  v->replaceAll(func);
+  auto *method = M->getOrRealizeFunc(secureProfileMethod, argsTypes, {}, perfModule);
+  if ( !method ) return;
+
+  auto *profiledCall = util::call(method, args);
+  profiledCall->setSrcInfo(srcInfo);
+  v->replaceAll(profiledCall);
 }
 
-void Profiler::handle(codon::ir::CallInstr *v) { attachProfiler(v); }
+void Profiler::handle( CallInstr *v ) { attachProfiler(v); }
 
 } // namespace sequre
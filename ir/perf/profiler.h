@@ -5,13 +5,15 @@
 
 namespace sequre {
 
+const std::string ENV_PROFILE = "SEQURE_PROFILE";
+
 class Profiler : public codon::ir::transform::OperatorPass {
   const std::string KEY = "sequre-profiler";
   std::string getKey() const override { return KEY; }
 
-  void handle(codon::ir::CallInstr *) override;
+  void handle( codon::ir::CallInstr * ) override;
 
-  void attachProfiler(codon::ir::CallInstr *);
+  void attachProfiler( codon::ir::CallInstr * );
 };
 
 } // namespace sequre
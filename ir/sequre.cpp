@@ -1,14 +1,21 @@
 #include "sequre.h"
 #include "expr.h"
+#include "batching.h"
 #include "obsolete/mpc.h"
 #include "mhe.h"
 #include "debugger.h"
+#include "perf/profiler.h"
+
+#include <cstdlib>
 
 namespace sequre {
 
 void Sequre::addIRPasses( codon::ir::transform::PassManager *pm, bool debug ) {
   pm->registerPass(std::make_unique<ExpressivenessTransformations>(), debug ? "" : "core-folding-pass-group:2");
+  // Opt-in: instruments the lowered secure calls, hence registered after the expressiveness transformations
+  if ( std::getenv(ENV_PROFILE.c_str()) ) pm->registerPass(std::make_unique<Profiler>(), debug ? "" : "core-folding-pass-group:2");
   pm->registerPass(std::make_unique<MPCOptimizations>(), "sequre-expressiveness-transformation");
+  pm->registerPass(std::make_unique<RoundBatching>(), "sequre-expressiveness-transformation");
   pm->registerPass(std::make_unique<MHEOptimizations>(), "sequre-mpc-opt");
   pm->registerPass(std::make_unique<Debugger>(), "sequre-mhe-opt");
 }
@@ -3,6 +3,12 @@
 echo "Cleaning up sockets ..."
 find . -name 'sock.*' -exec rm {} \;
 
+if [[ $* == *--profile* ]]
+then
+    echo "Profiling secure operations ..."
+    export SEQURE_PROFILE=1
+fi
+
 if [[ $* == *--jit* ]]
 then
     echo "Running $2 in $1 mode ..."